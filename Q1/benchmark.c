@@ -0,0 +1,235 @@
+#include "job_directory.h"
+
+#define DEFAULT_JOBS 100000
+#define DEFAULT_BLOCKS 4096
+#define RUNS 5
+
+// Words used to build synthetic job listings
+static const char* TITLES[] = { "Software Engineer", "Data Analyst", "Product Manager",
+                                "DevOps Engineer", "Sales Associate", "Data Engineer" };
+static const char* COMPANIES[] = { "Acme", "Globex", "Initech", "Umbrella", "Hooli" };
+static const char* LOCATIONS[] = { "Kigali", "Nairobi", "Lagos", "Accra", "Remote" };
+static const char* DESCRIPTIONS[] = { "Build and run backend systems",
+                                      "Analyse data and report insights",
+                                      "Own the roadmap for a product line",
+                                      "Grow accounts across the region" };
+
+// Segment sizes and thread counts compared by the load benchmark
+static const int SEGMENT_SIZES[] = { 16, 64, 256, 1024 };
+static const int THREAD_COUNTS[] = { 1, 2, 4, 8 };
+
+#define COUNT(array) (int)(sizeof(array) / sizeof(array[0]))
+
+// Fill in the job stored in block `i` of a synthetic directory
+static void make_job(Job* job, int i) {
+    snprintf(job->id, sizeof(job->id), "J%04d", i % 10000);
+    snprintf(job->title, sizeof(job->title), "%s", TITLES[i % COUNT(TITLES)]);
+    snprintf(job->company, sizeof(job->company), "%s", COMPANIES[i % COUNT(COMPANIES)]);
+    snprintf(job->location, sizeof(job->location), "%s", LOCATIONS[i % COUNT(LOCATIONS)]);
+    snprintf(job->description, sizeof(job->description), "%s", DESCRIPTIONS[i % COUNT(DESCRIPTIONS)]);
+}
+
+// Build a chain of `n` synthetic jobs one minute apart. Blocks are linked
+// directly (without mining) since only search cost is being measured.
+static void build_directory(Blockchain* bc, int n) {
+    Block* prev = NULL;
+
+    for (int i = 0; i < n; i++) {
+        Block* block = (Block*)calloc(1, sizeof(Block));
+        if (!block) {
+            printf("Memory allocation failed\n");
+            exit(1);
+        }
+
+        block->index = i;
+        block->timestamp = 1700000000 + (time_t)i * 60;
+        make_job(&block->job, i);
+
+        if (prev) {
+            prev->next = block;
+        } else {
+            bc->head = block;
+        }
+        prev = block;
+        index_block(bc, block);
+        bc->job_count++;
+    }
+}
+
+// Time rank_jobs for one query and print the best and average latency
+static void time_ranked_query(Blockchain* bc, const char* query, int k, int recency_boost) {
+    ScoredJob results[DEFAULT_TOP_K];
+    double best = 0.0;
+    double total = 0.0;
+    int count = 0;
+    int matches = 0;
+
+    for (int run = 0; run < RUNS; run++) {
+        double start = now_ms();
+        count = rank_jobs(bc, query, k, recency_boost, results, &matches);
+        double elapsed = now_ms() - start;
+
+        total += elapsed;
+        if (run == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    printf("rank_jobs k=%-3d boost=%d %-22s %7d matches  %3d results  best %8.3f ms  avg %8.3f ms\n",
+           k, recency_boost, query, matches, count, best, total / RUNS);
+}
+
+// Build a valid chain of `n` mined blocks one minute apart, so it can be
+// saved, loaded and verified. Mining cost grows 16x per DIFFICULTY level.
+static void build_chain(Blockchain* bc, int n) {
+    Block* prev = NULL;
+
+    for (int i = 0; i < n; i++) {
+        Block* block = (Block*)calloc(1, sizeof(Block));
+        if (!block) {
+            printf("Memory allocation failed\n");
+            exit(1);
+        }
+
+        block->index = i;
+        block->timestamp = 1700000000 + (time_t)i * 60;
+        make_job(&block->job, i);
+        strcpy(block->prev_hash, prev ? prev->hash : "N/A");
+        mine_block(block);
+
+        if (prev) {
+            prev->next = block;
+        } else {
+            bc->head = block;
+        }
+        prev = block;
+        index_block(bc, block);
+        bc->job_count++;
+    }
+}
+
+// Remove a saved chain: its manifest, segment files and any temporary files
+static void remove_chain(const char* filename, int segment_count) {
+    char path[FILENAME_MAX + 16];
+
+    for (int s = 0; s < segment_count; s++) {
+        snprintf(path, sizeof(path), "%s.%04d", filename, s);
+        remove(path);
+    }
+    remove(filename);
+}
+
+// Time load_blockchain and verify_integrity of the chain saved as
+// `filename` with `threads` worker threads and print the best and average
+static void time_load(const char* filename, int segment_size, int threads) {
+    char value[16];
+    double best_load = 0.0, total_load = 0.0;
+    double best_verify = 0.0, total_verify = 0.0;
+    int blocks = 0;
+    int used = 0;
+
+    snprintf(value, sizeof(value), "%d", threads);
+    setenv("JD_THREADS", value, 1);
+
+    for (int run = 0; run < RUNS; run++) {
+        Blockchain bc;
+        init_blockchain(&bc);
+        if (!load_blockchain(&bc, filename)) {
+            printf("Failed to load %s\n", filename);
+            exit(1);
+        }
+
+        double start = now_ms();
+        int valid = verify_integrity(&bc);
+        double verify = now_ms() - start;
+        double load = bc.last_load.elapsed_ms;
+        if (!valid) {
+            printf("Integrity check of %s failed\n", filename);
+            exit(1);
+        }
+
+        total_load += load;
+        total_verify += verify;
+        if (run == 0 || load < best_load) {
+            best_load = load;
+        }
+        if (run == 0 || verify < best_verify) {
+            best_verify = verify;
+        }
+        blocks = bc.block_count;
+        used = bc.last_load.thread_count;
+        free_blockchain(&bc);
+    }
+
+    printf("segment %-5d threads %d (%d used)  %6d blocks  load best %8.3f ms  avg %8.3f ms  "
+           "verify best %8.3f ms  avg %8.3f ms\n",
+           segment_size, threads, used, blocks, best_load, total_load / RUNS,
+           best_verify, total_verify / RUNS);
+}
+
+// Save a mined chain of `n` blocks with each segment size in turn and time
+// loading and verifying it with each thread count
+static void benchmark_load(int n) {
+    char dir[] = "/tmp/jd_benchmark_XXXXXX";
+    if (!mkdtemp(dir)) {
+        printf("Error creating a temporary directory\n");
+        exit(1);
+    }
+
+    Blockchain bc;
+    init_blockchain(&bc);
+
+    double start = now_ms();
+    build_chain(&bc, n);
+    printf("Mined a chain of %d blocks at difficulty %d in %.3f ms.\n\n", n, DIFFICULTY, now_ms() - start);
+
+    for (int i = 0; i < COUNT(SEGMENT_SIZES); i++) {
+        char filename[FILENAME_MAX];
+        int segment_size = SEGMENT_SIZES[i];
+        snprintf(filename, sizeof(filename), "%s/blockchain_%d.dat", dir, segment_size);
+
+        bc.segment_size = segment_size;
+        if (!save_blockchain(&bc, filename)) {
+            printf("Failed to save %s\n", filename);
+            exit(1);
+        }
+        for (int t = 0; t < COUNT(THREAD_COUNTS); t++) {
+            time_load(filename, segment_size, THREAD_COUNTS[t]);
+        }
+        remove_chain(filename, (n + segment_size - 1) / segment_size);
+    }
+
+    rmdir(dir);
+    free_blockchain(&bc);
+}
+
+// Usage: ./benchmark [number of jobs]
+//        ./benchmark load [number of blocks]
+int main(int argc, char* argv[]) {
+    if (argc > 1 && strcmp(argv[1], "load") == 0) {
+        int n = argc > 2 ? atoi(argv[2]) : DEFAULT_BLOCKS;
+        benchmark_load(n > 0 ? n : DEFAULT_BLOCKS);
+        return 0;
+    }
+
+    int n = argc > 1 ? atoi(argv[1]) : DEFAULT_JOBS;
+    if (n <= 0) {
+        n = DEFAULT_JOBS;
+    }
+
+    Blockchain bc;
+    init_blockchain(&bc);
+
+    double start = now_ms();
+    build_directory(&bc, n);
+    printf("Built a synthetic directory of %d jobs in %.3f ms.\n\n", n, now_ms() - start);
+
+    time_ranked_query(&bc, "engineer", DEFAULT_TOP_K, 0);
+    time_ranked_query(&bc, "engineer", DEFAULT_TOP_K, 1);
+    time_ranked_query(&bc, "data analyst", DEFAULT_TOP_K, 0);
+    time_ranked_query(&bc, "roadmap", DEFAULT_TOP_K, 0);
+    time_ranked_query(&bc, "nonexistent", DEFAULT_TOP_K, 0);
+
+    free_blockchain(&bc);
+    return 0;
+}
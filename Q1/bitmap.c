@@ -0,0 +1,582 @@
+#include "bitmap.h"
+
+// Initialize an empty bitmap
+void bitmap_init(Bitmap* bm) {
+    bm->containers = NULL;
+    bm->count = 0;
+    bm->capacity = 0;
+}
+
+// Free the memory held by a bitmap and leave it empty
+void bitmap_free(Bitmap* bm) {
+    for (int i = 0; i < bm->count; i++) {
+        free(bm->containers[i].array);
+        free(bm->containers[i].bits);
+    }
+    free(bm->containers);
+    bitmap_init(bm);
+}
+
+// Find the container with `key`. Returns its position, or -(insert position + 1)
+static int find_container(const Bitmap* bm, uint16_t key) {
+    int low = 0;
+    int high = bm->count - 1;
+
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        if (bm->containers[mid].key == key) {
+            return mid;
+        } else if (bm->containers[mid].key < key) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return -(low + 1);
+}
+
+// Find `value` in a sorted array. Returns its position, or -(insert position + 1)
+static int find_low(const uint16_t* array, int count, uint16_t value) {
+    int low = 0;
+    int high = count - 1;
+
+    // Values are usually appended in increasing order, so check the end first
+    if (count > 0 && array[count - 1] < value) {
+        return -(count + 1);
+    }
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        if (array[mid] == value) {
+            return mid;
+        } else if (array[mid] < value) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return -(low + 1);
+}
+
+// Convert a full array container into a bitset container
+static int array_to_bitset(Container* c) {
+    uint64_t* bits = (uint64_t*)calloc(BITSET_WORDS, sizeof(uint64_t));
+    if (!bits) {
+        return 0;
+    }
+
+    for (int i = 0; i < c->cardinality; i++) {
+        bits[c->array[i] >> 6] |= 1ULL << (c->array[i] & 63);
+    }
+    free(c->array);
+    c->array = NULL;
+    c->capacity = 0;
+    c->bits = bits;
+    return 1;
+}
+
+// Add a value to the bitmap. Returns 0 if memory allocation failed.
+int bitmap_add(Bitmap* bm, uint32_t value) {
+    uint16_t key = value >> 16;
+    uint16_t low = value & 0xFFFF;
+    int pos = find_container(bm, key);
+
+    // Insert a new, empty array container in key order
+    if (pos < 0) {
+        pos = -pos - 1;
+        if (bm->count == bm->capacity) {
+            int new_capacity = bm->capacity ? bm->capacity * 2 : 4;
+            Container* grown = (Container*)realloc(bm->containers, new_capacity * sizeof(Container));
+            if (!grown) {
+                return 0;
+            }
+            bm->containers = grown;
+            bm->capacity = new_capacity;
+        }
+        memmove(&bm->containers[pos + 1], &bm->containers[pos],
+                (bm->count - pos) * sizeof(Container));
+        bm->containers[pos].key = key;
+        bm->containers[pos].cardinality = 0;
+        bm->containers[pos].array = NULL;
+        bm->containers[pos].capacity = 0;
+        bm->containers[pos].bits = NULL;
+        bm->count++;
+    }
+
+    Container* c = &bm->containers[pos];
+    if (!c->bits) {
+        int at = find_low(c->array, c->cardinality, low);
+        if (at >= 0) {
+            return 1;  // Already present
+        }
+        at = -at - 1;
+
+        if (c->cardinality < ARRAY_CONTAINER_MAX) {
+            if (c->cardinality == c->capacity) {
+                int new_capacity = c->capacity ? c->capacity * 2 : 4;
+                uint16_t* grown = (uint16_t*)realloc(c->array, new_capacity * sizeof(uint16_t));
+                if (!grown) {
+                    return 0;
+                }
+                c->array = grown;
+                c->capacity = new_capacity;
+            }
+            memmove(&c->array[at + 1], &c->array[at], (c->cardinality - at) * sizeof(uint16_t));
+            c->array[at] = low;
+            c->cardinality++;
+            return 1;
+        }
+
+        // The array is full: switch to a bitset
+        if (!array_to_bitset(c)) {
+            return 0;
+        }
+    }
+
+    uint64_t mask = 1ULL << (low & 63);
+    if (!(c->bits[low >> 6] & mask)) {
+        c->bits[low >> 6] |= mask;
+        c->cardinality++;
+    }
+    return 1;
+}
+
+// Check whether the bitmap contains `value`
+int bitmap_contains(const Bitmap* bm, uint32_t value) {
+    int pos = find_container(bm, value >> 16);
+    if (pos < 0) {
+        return 0;
+    }
+
+    const Container* c = &bm->containers[pos];
+    uint16_t low = value & 0xFFFF;
+    if (c->bits) {
+        return (c->bits[low >> 6] >> (low & 63)) & 1;
+    }
+    return find_low(c->array, c->cardinality, low) >= 0;
+}
+
+// Number of values in the bitmap
+int bitmap_cardinality(const Bitmap* bm) {
+    int total = 0;
+    for (int i = 0; i < bm->count; i++) {
+        total += bm->containers[i].cardinality;
+    }
+    return total;
+}
+
+// Intersect two containers with the same key.
+// If `out` is not NULL the intersection is stored in it (as an array when it
+// is small enough, otherwise as a bitset). Returns the intersection size, or
+// -1 if memory allocation failed.
+static int container_and(const Container* a, const Container* b, Container* out) {
+    int count = 0;
+
+    if (a->bits && b->bits) {
+        for (int w = 0; w < BITSET_WORDS; w++) {
+            count += __builtin_popcountll(a->bits[w] & b->bits[w]);
+        }
+        if (!out || count == 0) {
+            return count;
+        }
+
+        out->cardinality = count;
+        if (count > ARRAY_CONTAINER_MAX) {
+            out->bits = (uint64_t*)malloc(BITSET_WORDS * sizeof(uint64_t));
+            if (!out->bits) {
+                return -1;
+            }
+            for (int w = 0; w < BITSET_WORDS; w++) {
+                out->bits[w] = a->bits[w] & b->bits[w];
+            }
+            return count;
+        }
+
+        out->array = (uint16_t*)malloc(count * sizeof(uint16_t));
+        if (!out->array) {
+            return -1;
+        }
+        out->capacity = count;
+        int n = 0;
+        for (int w = 0; w < BITSET_WORDS; w++) {
+            uint64_t word = a->bits[w] & b->bits[w];
+            while (word) {
+                out->array[n++] = (uint16_t)(w * 64 + __builtin_ctzll(word));
+                word &= word - 1;
+            }
+        }
+        return count;
+    }
+
+    // At least one side is an array, so the result is an array no larger than it
+    if (a->bits) {
+        const Container* tmp = a;
+        a = b;
+        b = tmp;
+    }
+    if (out) {
+        out->array = (uint16_t*)malloc((a->cardinality ? a->cardinality : 1) * sizeof(uint16_t));
+        if (!out->array) {
+            return -1;
+        }
+        out->capacity = a->cardinality;
+    }
+
+    if (b->bits) {
+        for (int i = 0; i < a->cardinality; i++) {
+            uint16_t v = a->array[i];
+            if ((b->bits[v >> 6] >> (v & 63)) & 1) {
+                if (out) {
+                    out->array[count] = v;
+                }
+                count++;
+            }
+        }
+    } else {
+        int i = 0;
+        int j = 0;
+        while (i < a->cardinality && j < b->cardinality) {
+            if (a->array[i] < b->array[j]) {
+                i++;
+            } else if (a->array[i] > b->array[j]) {
+                j++;
+            } else {
+                if (out) {
+                    out->array[count] = a->array[i];
+                }
+                count++;
+                i++;
+                j++;
+            }
+        }
+    }
+
+    if (out) {
+        out->cardinality = count;
+    }
+    return count;
+}
+
+// Store the intersection of `a` and `b` in `out` (which must be initialized
+// and empty). Returns 0 if memory allocation failed.
+int bitmap_and(const Bitmap* a, const Bitmap* b, Bitmap* out) {
+    int i = 0;
+    int j = 0;
+
+    while (i < a->count && j < b->count) {
+        const Container* ca = &a->containers[i];
+        const Container* cb = &b->containers[j];
+
+        if (ca->key < cb->key) {
+            i++;
+            continue;
+        }
+        if (ca->key > cb->key) {
+            j++;
+            continue;
+        }
+
+        if (out->count == out->capacity) {
+            int new_capacity = out->capacity ? out->capacity * 2 : 4;
+            Container* grown = (Container*)realloc(out->containers, new_capacity * sizeof(Container));
+            if (!grown) {
+                return 0;
+            }
+            out->containers = grown;
+            out->capacity = new_capacity;
+        }
+
+        Container* c = &out->containers[out->count];
+        c->key = ca->key;
+        c->cardinality = 0;
+        c->array = NULL;
+        c->capacity = 0;
+        c->bits = NULL;
+
+        int count = container_and(ca, cb, c);
+        if (count < 0) {
+            return 0;
+        }
+        if (count > 0) {
+            out->count++;
+        } else {
+            free(c->array);
+        }
+        i++;
+        j++;
+    }
+    return 1;
+}
+
+// Size of the intersection of `a` and `b`, without building it
+int bitmap_and_cardinality(const Bitmap* a, const Bitmap* b) {
+    int i = 0;
+    int j = 0;
+    int total = 0;
+
+    while (i < a->count && j < b->count) {
+        if (a->containers[i].key < b->containers[j].key) {
+            i++;
+        } else if (a->containers[i].key > b->containers[j].key) {
+            j++;
+        } else {
+            total += container_and(&a->containers[i], &b->containers[j], NULL);
+            i++;
+            j++;
+        }
+    }
+    return total;
+}
+
+// Merge the values of container `src` into `dst` (same key).
+// Returns 0 if memory allocation failed.
+static int container_or(Container* dst, const Container* src) {
+    // Small unions stay arrays: merge the two sorted arrays
+    if (!dst->bits && !src->bits && dst->cardinality + src->cardinality <= ARRAY_CONTAINER_MAX) {
+        int total = dst->cardinality + src->cardinality;
+        uint16_t* merged = (uint16_t*)malloc((total ? total : 1) * sizeof(uint16_t));
+        if (!merged) {
+            return 0;
+        }
+
+        int i = 0;
+        int j = 0;
+        int n = 0;
+        while (i < dst->cardinality || j < src->cardinality) {
+            if (j == src->cardinality || (i < dst->cardinality && dst->array[i] < src->array[j])) {
+                merged[n++] = dst->array[i++];
+            } else if (i == dst->cardinality || src->array[j] < dst->array[i]) {
+                merged[n++] = src->array[j++];
+            } else {
+                merged[n++] = dst->array[i++];
+                j++;
+            }
+        }
+
+        free(dst->array);
+        dst->array = merged;
+        dst->capacity = total;
+        dst->cardinality = n;
+        return 1;
+    }
+
+    // Otherwise the result is a bitset
+    if (!dst->bits && !array_to_bitset(dst)) {
+        return 0;
+    }
+    if (src->bits) {
+        for (int w = 0; w < BITSET_WORDS; w++) {
+            dst->bits[w] |= src->bits[w];
+        }
+    } else {
+        for (int i = 0; i < src->cardinality; i++) {
+            dst->bits[src->array[i] >> 6] |= 1ULL << (src->array[i] & 63);
+        }
+    }
+
+    int count = 0;
+    for (int w = 0; w < BITSET_WORDS; w++) {
+        count += __builtin_popcountll(dst->bits[w]);
+    }
+    dst->cardinality = count;
+    return 1;
+}
+
+// Add every value of `src` to `dst`. Returns 0 if memory allocation failed.
+int bitmap_or(Bitmap* dst, const Bitmap* src) {
+    for (int i = 0; i < src->count; i++) {
+        const Container* sc = &src->containers[i];
+        int pos = find_container(dst, sc->key);
+
+        if (pos >= 0) {
+            if (!container_or(&dst->containers[pos], sc)) {
+                return 0;
+            }
+            continue;
+        }
+
+        // Insert an empty container for the key and merge into it
+        pos = -pos - 1;
+        if (dst->count == dst->capacity) {
+            int new_capacity = dst->capacity ? dst->capacity * 2 : 4;
+            Container* grown = (Container*)realloc(dst->containers, new_capacity * sizeof(Container));
+            if (!grown) {
+                return 0;
+            }
+            dst->containers = grown;
+            dst->capacity = new_capacity;
+        }
+        memmove(&dst->containers[pos + 1], &dst->containers[pos],
+                (dst->count - pos) * sizeof(Container));
+        Container* c = &dst->containers[pos];
+        c->key = sc->key;
+        c->cardinality = 0;
+        c->array = NULL;
+        c->capacity = 0;
+        c->bits = NULL;
+        dst->count++;
+
+        if (!container_or(c, sc)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Write the values of the bitmap to `out` in increasing order.
+// `out` must hold bitmap_cardinality(bm) values. Returns the number written.
+int bitmap_to_array(const Bitmap* bm, uint32_t* out) {
+    int n = 0;
+
+    for (int i = 0; i < bm->count; i++) {
+        const Container* c = &bm->containers[i];
+        uint32_t high = (uint32_t)c->key << 16;
+
+        if (c->bits) {
+            for (int w = 0; w < BITSET_WORDS; w++) {
+                uint64_t word = c->bits[w];
+                while (word) {
+                    out[n++] = high | (uint32_t)(w * 64 + __builtin_ctzll(word));
+                    word &= word - 1;
+                }
+            }
+        } else {
+            for (int k = 0; k < c->cardinality; k++) {
+                out[n++] = high | c->array[k];
+            }
+        }
+    }
+    return n;
+}
+
+// Call `fn(value, arg)` for each value of the bitmap in increasing order
+void bitmap_for_each(const Bitmap* bm, void (*fn)(uint32_t value, void* arg), void* arg) {
+    for (int i = 0; i < bm->count; i++) {
+        const Container* c = &bm->containers[i];
+        uint32_t high = (uint32_t)c->key << 16;
+
+        if (c->bits) {
+            for (int w = 0; w < BITSET_WORDS; w++) {
+                uint64_t word = c->bits[w];
+                while (word) {
+                    fn(high | (uint32_t)(w * 64 + __builtin_ctzll(word)), arg);
+                    word &= word - 1;
+                }
+            }
+        } else {
+            for (int k = 0; k < c->cardinality; k++) {
+                fn(high | c->array[k], arg);
+            }
+        }
+    }
+}
+
+// Case-insensitive FNV-1a hash of a key
+static unsigned int hash_key(const char* key) {
+    unsigned int hash = 2166136261u;
+    for (; *key; key++) {
+        hash ^= (unsigned char)tolower((unsigned char)*key);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Case-insensitive string comparison
+static int keys_equal(const char* a, const char* b) {
+    while (*a && tolower((unsigned char)*a) == tolower((unsigned char)*b)) {
+        a++;
+        b++;
+    }
+    return tolower((unsigned char)*a) == tolower((unsigned char)*b);
+}
+
+// Find the bucket holding `key`, or the empty bucket where it would go
+static int find_bucket(const BitmapIndex* index, const char* key) {
+    unsigned int mask = index->bucket_count - 1;
+    unsigned int b = hash_key(key) & mask;
+
+    while (index->buckets[b] >= 0 && !keys_equal(index->entries[index->buckets[b]].key, key)) {
+        b = (b + 1) & mask;
+    }
+    return b;
+}
+
+// Double the hash table and re-insert every entry
+static int grow_buckets(BitmapIndex* index) {
+    int new_count = index->bucket_count ? index->bucket_count * 2 : 16;
+    int* buckets = (int*)malloc(new_count * sizeof(int));
+    if (!buckets) {
+        return 0;
+    }
+
+    free(index->buckets);
+    index->buckets = buckets;
+    index->bucket_count = new_count;
+    for (int b = 0; b < new_count; b++) {
+        buckets[b] = -1;
+    }
+    for (int e = 0; e < index->count; e++) {
+        buckets[find_bucket(index, index->entries[e].key)] = e;
+    }
+    return 1;
+}
+
+// Initialize an empty index
+void index_init(BitmapIndex* index) {
+    index->entries = NULL;
+    index->count = 0;
+    index->capacity = 0;
+    index->buckets = NULL;
+    index->bucket_count = 0;
+}
+
+// Free the memory held by an index and leave it empty
+void index_free(BitmapIndex* index) {
+    for (int e = 0; e < index->count; e++) {
+        free(index->entries[e].key);
+        bitmap_free(&index->entries[e].bitmap);
+    }
+    free(index->entries);
+    free(index->buckets);
+    index_init(index);
+}
+
+// File `value` under `key`. Returns 0 if memory allocation failed.
+int index_add(BitmapIndex* index, const char* key, uint32_t value) {
+    // Keep the table at most half full
+    if ((index->count + 1) * 2 > index->bucket_count && !grow_buckets(index)) {
+        return 0;
+    }
+
+    int b = find_bucket(index, key);
+    if (index->buckets[b] < 0) {
+        if (index->count == index->capacity) {
+            int new_capacity = index->capacity ? index->capacity * 2 : 16;
+            IndexEntry* grown = (IndexEntry*)realloc(index->entries, new_capacity * sizeof(IndexEntry));
+            if (!grown) {
+                return 0;
+            }
+            index->entries = grown;
+            index->capacity = new_capacity;
+        }
+
+        IndexEntry* entry = &index->entries[index->count];
+        entry->key = strdup(key);
+        if (!entry->key) {
+            return 0;
+        }
+        bitmap_init(&entry->bitmap);
+        index->buckets[b] = index->count++;
+    }
+
+    return bitmap_add(&index->entries[index->buckets[b]].bitmap, value);
+}
+
+// Look up the bitmap filed under `key`, or NULL if the key is unknown
+const Bitmap* index_find(const BitmapIndex* index, const char* key) {
+    if (index->bucket_count == 0) {
+        return NULL;
+    }
+
+    int b = find_bucket(index, key);
+    return index->buckets[b] < 0 ? NULL : &index->entries[index->buckets[b]].bitmap;
+}
@@ -0,0 +1,63 @@
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define ARRAY_CONTAINER_MAX 4096   // Largest container kept as a sorted array
+#define BITSET_WORDS 1024          // 64-bit words in a bitset container (65536 bits)
+
+// A container holds the values of a bitmap that share their high 16 bits.
+// Sparse containers are sorted arrays of the low 16 bits; dense ones are
+// 65536-bit bitsets (the same layout as a Roaring bitmap).
+typedef struct {
+    uint16_t key;           // High 16 bits shared by all values in the container
+    int cardinality;        // Number of values in the container
+    uint16_t* array;        // Sorted low bits, or NULL if the container is a bitset
+    int capacity;           // Allocated length of `array`
+    uint64_t* bits;         // Bitset of low bits, or NULL if the container is an array
+} Container;
+
+// Compressed bitmap of 32-bit values
+typedef struct {
+    Container* containers;  // Containers sorted by key
+    int count;              // Number of containers in use
+    int capacity;           // Allocated length of `containers`
+} Bitmap;
+
+// An index entry: one distinct key and the bitmap of values filed under it
+typedef struct {
+    char* key;              // Key as first seen (lookups ignore case)
+    Bitmap bitmap;          // Values filed under the key
+} IndexEntry;
+
+// Case-insensitive map from strings to bitmaps
+typedef struct {
+    IndexEntry* entries;    // Entries in insertion order
+    int count;              // Number of entries in use
+    int capacity;           // Allocated length of `entries`
+    int* buckets;           // Open-addressing hash table of entry positions (-1 = empty)
+    int bucket_count;       // Size of `buckets` (a power of two)
+} BitmapIndex;
+
+// Bitmap functions
+void bitmap_init(Bitmap* bm);
+void bitmap_free(Bitmap* bm);
+int bitmap_add(Bitmap* bm, uint32_t value);
+int bitmap_contains(const Bitmap* bm, uint32_t value);
+int bitmap_cardinality(const Bitmap* bm);
+int bitmap_and(const Bitmap* a, const Bitmap* b, Bitmap* out);
+int bitmap_and_cardinality(const Bitmap* a, const Bitmap* b);
+int bitmap_or(Bitmap* dst, const Bitmap* src);
+int bitmap_to_array(const Bitmap* bm, uint32_t* out);
+void bitmap_for_each(const Bitmap* bm, void (*fn)(uint32_t value, void* arg), void* arg);
+
+// Index functions
+void index_init(BitmapIndex* index);
+void index_free(BitmapIndex* index);
+int index_add(BitmapIndex* index, const char* key, uint32_t value);
+const Bitmap* index_find(const BitmapIndex* index, const char* key);
+
+#endif // BITMAP_H
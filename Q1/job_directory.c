@@ -11,11 +11,71 @@ void to_lowercase(char *str) {
 void init_blockchain(Blockchain* bc) {
     bc->head = NULL;
     bc->job_count = 0;  // Initialize job count
+    bc->last_load.segment_count = 0;
+    bc->last_load.thread_count = 0;
+    bc->last_load.elapsed_ms = 0.0;
+    bc->load_failed = 0;
+    bc->segment_size = SEGMENT_SIZE;
+    bc->blocks = NULL;
+    bc->block_count = 0;
+    bc->block_capacity = 0;
+    bc->time_index.sorted = NULL;
+    bc->time_index.sorted_count = 0;
+    bc->time_index.sorted_capacity = 0;
+    index_init(&bc->company_index);
+    index_init(&bc->location_index);
+    index_init(&bc->term_index);
+    bc->total_length = 0.0;
 }
 
-// Calculate the hash of a block
-char* calculate_hash(Block* block) {
-    static char hash[HASH_SIZE + 1];
+// Free a linked list of blocks
+static void free_blocks(Block* head) {
+    while (head) {
+        Block* next = head->next;
+        free(head);
+        head = next;
+    }
+}
+
+// Free all blocks and indexes of the blockchain and leave it empty
+void free_blockchain(Blockchain* bc) {
+    free_blocks(bc->head);
+    free(bc->blocks);
+    free(bc->time_index.sorted);
+    index_free(&bc->company_index);
+    index_free(&bc->location_index);
+    index_free(&bc->term_index);
+    init_blockchain(bc);
+}
+
+// Current monotonic time in milliseconds (used for timing loads and queries)
+double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Number of worker threads to use for a job split into `tasks` parts.
+// Defaults to the number of online CPUs; JD_THREADS overrides it.
+int get_worker_count(int tasks) {
+    int workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    const char* env = getenv("JD_THREADS");
+    
+    if (env && atoi(env) > 0) {
+        workers = atoi(env);
+    }
+    if (workers > MAX_WORKER_THREADS) {
+        workers = MAX_WORKER_THREADS;
+    }
+    if (workers > tasks) {
+        workers = tasks;
+    }
+    return workers < 1 ? 1 : workers;
+}
+
+// Calculate the hash of a block into `hash` (HASH_SIZE + 1 bytes).
+// Unlike calculate_hash this is safe to call from several threads.
+void compute_block_hash(const Block* block, char* hash) {
     char buffer[1024];
     SHA256_CTX sha256;
     unsigned char hash_bytes[SHA256_DIGEST_LENGTH];
@@ -35,7 +95,13 @@ char* calculate_hash(Block* block) {
     for (int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
         sprintf(hash + (i * 2), "%02x", hash_bytes[i]);
     }
+}
+
+// Calculate the hash of a block
+char* calculate_hash(Block* block) {
+    static char hash[HASH_SIZE + 1];
     
+    compute_block_hash(block, hash);
     return hash;
 }
 
@@ -93,6 +159,10 @@ void add_job(Blockchain* bc, Job job) {
     } else {
         last->next = new_block;
     }
+    
+    if (!index_block(bc, new_block)) {
+        printf("Memory allocation failed while indexing job %s\n", new_block->job.id);
+    }
 }
 
 // List all jobs in the blockchain
@@ -120,137 +190,1133 @@ void list_jobs(Blockchain* bc) {
     }
 }
 
+// Check whether any field of a job contains `lower_keyword` (case-insensitive)
+static int job_matches(const Job* job, const char* lower_keyword) {
+    const char* fields[] = { job->title, job->company, job->location, job->description };
+    char lower_field[500];  // Assuming the longest field is the description
+    
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        strcpy(lower_field, fields[i]);
+        to_lowercase(lower_field);
+        if (strstr(lower_field, lower_keyword)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Print the details of a job found by a search
+static void print_job(const Job* job) {
+    printf("Job ID: %s\n", job->id);
+    printf("Title: %s\n", job->title);
+    printf("Company: %s\n", job->company);
+    printf("Location: %s\n", job->location);
+    printf("Description: %s\n\n", job->description);
+}
+
 // Search for jobs using a keyword
 void search_jobs(Blockchain* bc, const char* keyword) {
     Block* current = bc->head;
     int found = 0;
     char lower_keyword[MAX_KEYWORD_LENGTH];
-    char lower_field[500];  // Assuming the longest field is the description
 
     // Convert keyword to lowercase for case-insensitive search
     strcpy(lower_keyword, keyword);
     to_lowercase(lower_keyword);
     
     while (current) {
-        // Check each field for the keyword (case-insensitive)
-        strcpy(lower_field, current->job.title);
-        to_lowercase(lower_field);
-        if (strstr(lower_field, lower_keyword)) {
+        if (job_matches(&current->job, lower_keyword)) {
             found = 1;
-            goto print_job;
+            print_job(&current->job);
         }
+        current = current->next;
+    }
+    
+    if (!found) {
+        printf("No jobs found matching the keyword: %s\n", keyword);
+    }
+}
 
-        strcpy(lower_field, current->job.company);
-        to_lowercase(lower_field);
-        if (strstr(lower_field, lower_keyword)) {
-            found = 1;
-            goto print_job;
+// Split `query` into unique lowercase terms; returns the number of terms
+static int parse_query(const char* query, char terms[][MAX_KEYWORD_LENGTH]) {
+    int term_count = 0;
+    int length = 0;
+    char token[MAX_KEYWORD_LENGTH];
+    
+    for (int i = 0; term_count < MAX_QUERY_TERMS; i++) {
+        if (isalnum((unsigned char)query[i])) {
+            if (length < MAX_KEYWORD_LENGTH - 1) {
+                token[length++] = tolower((unsigned char)query[i]);
+            }
+            continue;
         }
+        
+        if (length > 0) {
+            token[length] = '\0';
+            int duplicate = 0;
+            for (int t = 0; t < term_count; t++) {
+                duplicate |= strcmp(terms[t], token) == 0;
+            }
+            if (!duplicate) {
+                strcpy(terms[term_count++], token);
+            }
+            length = 0;
+        }
+        if (query[i] == '\0') {
+            break;
+        }
+    }
+    
+    return term_count;
+}
 
-        strcpy(lower_field, current->job.location);
-        to_lowercase(lower_field);
-        if (strstr(lower_field, lower_keyword)) {
-            found = 1;
-            goto print_job;
+// Add `weight` to counts[t] for each occurrence of terms[t] in `text`.
+// Words are kept whole, as in the term index. Returns the weighted number
+// of tokens in `text`.
+static double count_terms(const char* text, char terms[][MAX_KEYWORD_LENGTH],
+                          int term_count, double weight, double* counts) {
+    int tokens = 0;
+    int length = 0;
+    char token[500];  // Assuming the longest field is the description
+    
+    for (int i = 0; ; i++) {
+        if (isalnum((unsigned char)text[i])) {
+            if (length < (int)sizeof(token) - 1) {
+                token[length++] = tolower((unsigned char)text[i]);
+            }
+            continue;
+        }
+        
+        if (length > 0) {
+            token[length] = '\0';
+            for (int t = 0; t < term_count; t++) {
+                if (strcmp(terms[t], token) == 0) {
+                    counts[t] += weight;
+                }
+            }
+            tokens++;
+            length = 0;
+        }
+        if (text[i] == '\0') {
+            break;
         }
+    }
+    
+    return tokens * weight;
+}
 
-        strcpy(lower_field, current->job.description);
-        to_lowercase(lower_field);
-        if (strstr(lower_field, lower_keyword)) {
-            found = 1;
-            goto print_job;
+// Field-weighted frequency of each query term in a job (into `tf`).
+// Returns the field-weighted number of tokens in the job.
+static double job_term_counts(const Block* block, char terms[][MAX_KEYWORD_LENGTH],
+                              int term_count, double* tf) {
+    double length = 0.0;
+    
+    for (int t = 0; t < term_count; t++) {
+        tf[t] = 0.0;
+    }
+    length += count_terms(block->job.title, terms, term_count, TITLE_WEIGHT, tf);
+    length += count_terms(block->job.company, terms, term_count, 1.0, tf);
+    length += count_terms(block->job.location, terms, term_count, 1.0, tf);
+    length += count_terms(block->job.description, terms, term_count, 1.0, tf);
+    return length;
+}
+
+// Whether result `a` ranks above result `b` (newer jobs win ties)
+static int ranks_above(const ScoredJob* a, const ScoredJob* b) {
+    if (a->score != b->score) {
+        return a->score > b->score;
+    }
+    return a->block->index > b->block->index;
+}
+
+// Restore the min-heap property (worst result at the root) below `i`
+static void sift_down(ScoredJob* heap, int size, int i) {
+    while (1) {
+        int worst = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        
+        if (left < size && ranks_above(&heap[worst], &heap[left])) {
+            worst = left;
         }
+        if (right < size && ranks_above(&heap[worst], &heap[right])) {
+            worst = right;
+        }
+        if (worst == i) {
+            return;
+        }
+        
+        ScoredJob tmp = heap[i];
+        heap[i] = heap[worst];
+        heap[worst] = tmp;
+        i = worst;
+    }
+}
 
-        current = current->next;
-        continue;
+// Offer a scored job to a min-heap of at most `k` results (worst at the root)
+static void heap_offer(ScoredJob* heap, int* size, int k, ScoredJob scored) {
+    if (*size < k) {
+        // Insert and sift the new result up towards the root
+        int j = (*size)++;
+        heap[j] = scored;
+        while (j > 0 && ranks_above(&heap[(j - 1) / 2], &heap[j])) {
+            ScoredJob tmp = heap[j];
+            heap[j] = heap[(j - 1) / 2];
+            heap[(j - 1) / 2] = tmp;
+            j = (j - 1) / 2;
+        }
+    } else if (ranks_above(&scored, &heap[0])) {
+        heap[0] = scored;
+        sift_down(heap, *size, 0);
+    }
+}
 
-    print_job:
-        printf("Job ID: %s\n", current->job.id);
-        printf("Title: %s\n", current->job.title);
-        printf("Company: %s\n", current->job.company);
-        printf("Location: %s\n", current->job.location);
-        printf("Description: %s\n\n", current->job.description);
-        current = current->next;
+// State shared by the scoring callback of rank_jobs
+typedef struct {
+    Blockchain* bc;
+    char (*terms)[MAX_KEYWORD_LENGTH];
+    int term_count;
+    const double* idf;
+    double avg_length;
+    int recency_boost;
+    time_t newest;
+    ScoredJob* results;     // k-sized min-heap
+    int k;
+    int size;               // Results in the heap
+} RankState;
+
+// Score the job at one candidate position into the heap
+static void score_position(uint32_t position, void* arg) {
+    RankState* state = (RankState*)arg;
+    Block* block = state->bc->blocks[position];
+    double tf[MAX_QUERY_TERMS];
+    double length = job_term_counts(block, state->terms, state->term_count, tf);
+    double norm = BM25_K1 * (1.0 - BM25_B + BM25_B * length /
+                             (state->avg_length > 0 ? state->avg_length : 1.0));
+    ScoredJob scored = { block, 0.0 };
+    
+    for (int t = 0; t < state->term_count; t++) {
+        scored.score += state->idf[t] * tf[t] * (BM25_K1 + 1.0) / (tf[t] + norm);
+    }
+    if (state->recency_boost) {
+        double age = difftime(state->newest, block->timestamp);
+        scored.score *= 1.0 + pow(0.5, age / RECENCY_HALF_LIFE);
+    }
+    heap_offer(state->results, &state->size, state->k, scored);
+}
+
+// Rank jobs against the keywords in `query` and store the best `k` in
+// `results`, best first. Scores use BM25 with title hits weighted by
+// TITLE_WEIGHT. With `recency_boost` set, newer jobs get up to twice
+// the score, halving every RECENCY_HALF_LIFE seconds of age relative
+// to the newest job.
+// Document frequencies come from the term index and the average job
+// length from a running total, so only jobs containing a query term are
+// read: their positions are the union of the terms' bitmaps, and each is
+// scored into a k-sized heap. Cost is O(matches * log k), independent of
+// the chain length. Returns the number of results; `match_count` (if not
+// NULL) receives the number of matching jobs.
+int rank_jobs(Blockchain* bc, const char* query, int k, int recency_boost,
+              ScoredJob* results, int* match_count) {
+    char terms[MAX_QUERY_TERMS][MAX_KEYWORD_LENGTH];
+    int term_count = parse_query(query, terms);
+    
+    if (match_count) {
+        *match_count = 0;
+    }
+    if (term_count == 0 || k <= 0 || bc->block_count == 0) {
+        return 0;
     }
     
-    if (!found) {
+    // Document frequencies and candidates from the postings of each term
+    int doc_count = bc->block_count;
+    double idf[MAX_QUERY_TERMS];
+    Bitmap candidates;
+    bitmap_init(&candidates);
+    
+    for (int t = 0; t < term_count; t++) {
+        const Bitmap* postings = index_find(&bc->term_index, terms[t]);
+        int df = postings ? bitmap_cardinality(postings) : 0;
+        
+        idf[t] = log(1.0 + (doc_count - df + 0.5) / (df + 0.5));
+        if (postings && !bitmap_or(&candidates, postings)) {
+            printf("Memory allocation failed\n");
+            bitmap_free(&candidates);
+            return 0;
+        }
+    }
+    
+    RankState state = { bc, terms, term_count, idf, bc->total_length / doc_count, recency_boost,
+                        bc->time_index.sorted[bc->time_index.sorted_count - 1]->timestamp,
+                        results, k, 0 };
+    bitmap_for_each(&candidates, score_position, &state);
+    int matches = bitmap_cardinality(&candidates);
+    bitmap_free(&candidates);
+    
+    // Pop the worst result to the end repeatedly, leaving the best first
+    for (int end = state.size - 1; end > 0; end--) {
+        ScoredJob tmp = results[0];
+        results[0] = results[end];
+        results[end] = tmp;
+        sift_down(results, end, 0);
+    }
+    
+    if (match_count) {
+        *match_count = matches;
+    }
+    return state.size;
+}
+
+// Print the top k jobs for `query`, best first, with the query latency
+void search_jobs_ranked(Blockchain* bc, const char* query, int k, int recency_boost) {
+    ScoredJob* results = (ScoredJob*)malloc((k > 0 ? k : 1) * sizeof(ScoredJob));
+    if (!results) {
+        printf("Memory allocation failed\n");
+        return;
+    }
+    
+    int match_count;
+    double start = now_ms();
+    int count = rank_jobs(bc, query, k, recency_boost, results, &match_count);
+    double elapsed = now_ms() - start;
+    
+    if (count == 0) {
+        printf("No jobs found matching the keywords: %s\n", query);
+    }
+    for (int i = 0; i < count; i++) {
+        printf("#%d (score %.3f)\n", i + 1, results[i].score);
+        print_job(&results[i].block->job);
+    }
+    printf("Showing top %d of %d matching job(s) (%.3f ms).\n", count, match_count, elapsed);
+    
+    free(results);
+}
+
+// File every lowercase word of `text` under `position` in the term index.
+// Words are kept whole so that substring lookups over them are exact.
+// Returns the number of words, or -1 if memory allocation failed.
+static int index_terms(BitmapIndex* index, const char* text, uint32_t position) {
+    char token[500];  // Assuming the longest field is the description
+    int length = 0;
+    int words = 0;
+    
+    for (int i = 0; ; i++) {
+        if (isalnum((unsigned char)text[i])) {
+            if (length < (int)sizeof(token) - 1) {
+                token[length++] = tolower((unsigned char)text[i]);
+            }
+            continue;
+        }
+        
+        if (length > 0) {
+            token[length] = '\0';
+            if (!index_add(index, token, position)) {
+                return -1;
+            }
+            words++;
+            length = 0;
+        }
+        if (text[i] == '\0') {
+            return words;
+        }
+    }
+}
+
+// Append a block pointer to a growable array. Returns 0 if memory allocation failed.
+static int append_block(Block*** array, int* count, int* capacity, Block* block) {
+    if (*count == *capacity) {
+        int new_capacity = *capacity ? *capacity * 2 : 64;
+        Block** grown = (Block**)realloc(*array, new_capacity * sizeof(Block*));
+        if (!grown) {
+            return 0;
+        }
+        *array = grown;
+        *capacity = new_capacity;
+    }
+    (*array)[(*count)++] = block;
+    return 1;
+}
+
+// Position of the first sorted block with a timestamp >= `t` (or > `t` if `after`)
+static int time_bound(const TimeIndex* index, time_t t, int after) {
+    int low = 0;
+    int high = index->sorted_count;
+    
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        time_t ts = index->sorted[mid]->timestamp;
+        if (ts < t || (after && ts == t)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Add a block to the time index. Blocks normally arrive in timestamp order
+// and are appended; a block older than the newest indexed one (e.g. after a
+// clock change) is inserted at its sorted position instead, which is rare
+// enough that the memmove does not matter.
+static int time_index_add(TimeIndex* index, Block* block) {
+    int pos = time_bound(index, block->timestamp, 1);
+    
+    if (!append_block(&index->sorted, &index->sorted_count, &index->sorted_capacity, block)) {
+        return 0;
+    }
+    if (pos < index->sorted_count - 1) {
+        memmove(&index->sorted[pos + 1], &index->sorted[pos],
+                (index->sorted_count - 1 - pos) * sizeof(Block*));
+        index->sorted[pos] = block;
+    }
+    return 1;
+}
+
+// Append a block to the position table and add it to the time, facet and
+// term indexes. Returns 0 if memory allocation failed.
+int index_block(Blockchain* bc, Block* block) {
+    uint32_t position = bc->block_count;
+    if (!append_block(&bc->blocks, &bc->block_count, &bc->block_capacity, block) ||
+        !time_index_add(&bc->time_index, block)) {
+        return 0;
+    }
+    
+    if (block->job.company[0] && !index_add(&bc->company_index, block->job.company, position)) {
+        return 0;
+    }
+    if (block->job.location[0] && !index_add(&bc->location_index, block->job.location, position)) {
+        return 0;
+    }
+    
+    // Index the words of each field and add the job's field-weighted length
+    // (as counted by job_term_counts) to the BM25 total
+    const char* fields[] = { block->job.title, block->job.company,
+                             block->job.location, block->job.description };
+    double length = 0.0;
+    for (int f = 0; f < 4; f++) {
+        int words = index_terms(&bc->term_index, fields[f], position);
+        if (words < 0) {
+            return 0;
+        }
+        length += f == 0 ? words * TITLE_WEIGHT : words;
+    }
+    bc->total_length += length;
+    return 1;
+}
+
+// Union of the bitmaps of every indexed word containing `piece`.
+// This scans the word dictionary, not the chain. Returns 0 if memory
+// allocation failed.
+static int match_piece(Blockchain* bc, const char* piece, Bitmap* out) {
+    for (int e = 0; e < bc->term_index.count; e++) {
+        if (strstr(bc->term_index.entries[e].key, piece) &&
+            !bitmap_or(out, &bc->term_index.entries[e].bitmap)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Positions of jobs containing `keyword` as a case-insensitive substring,
+// i.e. exactly the jobs search_jobs prints for it. The keyword is split into
+// alphanumeric pieces; each piece selects every indexed word containing it
+// and the pieces are intersected. A keyword that is one piece is answered
+// exactly this way; one with spaces or punctuation is then re-checked with
+// the search_jobs matcher, which only touches the candidates.
+// `*result` is set to NULL for an empty keyword (no filter), otherwise to
+// `owned`, which the caller must free. Returns 0 if memory allocation failed.
+static int match_keyword(Blockchain* bc, const char* keyword, Bitmap* owned, const Bitmap** result) {
+    char lower_keyword[MAX_KEYWORD_LENGTH];
+    char piece[MAX_KEYWORD_LENGTH];
+    int pieces = 0;
+    int single_piece = 1;
+    
+    *result = NULL;
+    if (keyword[0] == '\0') {
+        return 1;
+    }
+    *result = owned;
+    snprintf(lower_keyword, sizeof(lower_keyword), "%s", keyword);
+    to_lowercase(lower_keyword);
+    
+    for (int i = 0; lower_keyword[i]; ) {
+        if (!isalnum((unsigned char)lower_keyword[i])) {
+            single_piece = 0;
+            i++;
+            continue;
+        }
+        
+        int length = 0;
+        while (isalnum((unsigned char)lower_keyword[i])) {
+            piece[length++] = lower_keyword[i++];
+        }
+        piece[length] = '\0';
+        
+        Bitmap matches;
+        bitmap_init(&matches);
+        if (!match_piece(bc, piece, &matches)) {
+            bitmap_free(&matches);
+            return 0;
+        }
+        if (pieces++ == 0) {
+            bitmap_free(owned);
+            *owned = matches;
+            continue;
+        }
+        
+        Bitmap next;
+        bitmap_init(&next);
+        int ok = bitmap_and(owned, &matches, &next);
+        bitmap_free(&matches);
+        bitmap_free(owned);
+        *owned = next;
+        if (!ok) {
+            return 0;
+        }
+    }
+    
+    if (pieces == 1 && single_piece) {
+        return 1;
+    }
+    
+    // Re-check the candidates (every job if the keyword has no letters or
+    // digits) with the same matcher search_jobs uses
+    int count = pieces ? bitmap_cardinality(owned) : bc->block_count;
+    uint32_t* positions = (uint32_t*)malloc((count ? count : 1) * sizeof(uint32_t));
+    if (!positions) {
+        return 0;
+    }
+    if (pieces) {
+        bitmap_to_array(owned, positions);
+    } else {
+        for (int i = 0; i < count; i++) {
+            positions[i] = i;
+        }
+    }
+    
+    Bitmap verified;
+    bitmap_init(&verified);
+    int ok = 1;
+    for (int i = 0; i < count && ok; i++) {
+        if (job_matches(&bc->blocks[positions[i]]->job, lower_keyword)) {
+            ok = bitmap_add(&verified, positions[i]);
+        }
+    }
+    free(positions);
+    bitmap_free(owned);
+    *owned = verified;
+    return ok;
+}
+
+// Order facet counts by count (descending), then by value
+static int compare_facet_counts(const void* a, const void* b) {
+    const FacetCount* fa = (const FacetCount*)a;
+    const FacetCount* fb = (const FacetCount*)b;
+    
+    if (fa->count != fb->count) {
+        return fb->count - fa->count;
+    }
+    return strcmp(fa->value, fb->value);
+}
+
+// Count the jobs matching `keyword` (all jobs if empty) for each value of a
+// facet. Each count is a bitmap intersection, so the cost depends on the
+// bitmap sizes rather than the chain length. On success `*counts` holds the
+// non-zero counts, largest first, and must be freed by the caller.
+// Returns the number of counts, or -1 if memory allocation failed.
+int facet_counts(Blockchain* bc, FacetField field, const char* keyword, FacetCount** counts) {
+    BitmapIndex* index = field == FACET_COMPANY ? &bc->company_index : &bc->location_index;
+    Bitmap owned;
+    const Bitmap* filter;
+    
+    bitmap_init(&owned);
+    *counts = NULL;
+    if (!match_keyword(bc, keyword, &owned, &filter)) {
+        bitmap_free(&owned);
+        return -1;
+    }
+    
+    *counts = (FacetCount*)malloc((index->count ? index->count : 1) * sizeof(FacetCount));
+    if (!*counts) {
+        bitmap_free(&owned);
+        return -1;
+    }
+    
+    int n = 0;
+    for (int e = 0; e < index->count; e++) {
+        const Bitmap* bm = &index->entries[e].bitmap;
+        int count = filter ? bitmap_and_cardinality(bm, filter) : bitmap_cardinality(bm);
+        if (count > 0) {
+            (*counts)[n].value = index->entries[e].key;
+            (*counts)[n].count = count;
+            n++;
+        }
+    }
+    qsort(*counts, n, sizeof(FacetCount), compare_facet_counts);
+    
+    bitmap_free(&owned);
+    return n;
+}
+
+// Print the number of jobs matching `keyword` per company or location
+void print_facet_counts(Blockchain* bc, FacetField field, const char* keyword) {
+    FacetCount* counts;
+    double start = now_ms();
+    int n = facet_counts(bc, field, keyword, &counts);
+    double elapsed = now_ms() - start;
+    
+    if (n < 0) {
+        printf("Memory allocation failed\n");
+        return;
+    }
+    if (n == 0) {
         printf("No jobs found matching the keyword: %s\n", keyword);
     }
+    for (int i = 0; i < n; i++) {
+        printf("%-40s %d\n", counts[i].value, counts[i].count);
+    }
+    printf("%d %s value(s) (%.3f ms).\n", n,
+           field == FACET_COMPANY ? "company" : "location", elapsed);
+    
+    free(counts);
 }
 
-// Verify the integrity of the blockchain
-int verify_integrity(Blockchain* bc) {
-    Block* current = bc->head;
-    char calculated_hash[HASH_SIZE + 1];
-    char prev_hash[HASH_SIZE + 1] = {0};
+// Print the jobs matching all of the given filters. Empty filters are
+// ignored; `keyword` is matched like search_jobs does, and `company`
+// and `location` are matched exactly (ignoring case).
+void filter_jobs(Blockchain* bc, const char* keyword, const char* company, const char* location) {
+    double start = now_ms();
+    Bitmap owned;
+    Bitmap next;
+    const Bitmap* result;
+    const Bitmap* facets[2] = {
+        company[0] ? index_find(&bc->company_index, company) : NULL,
+        location[0] ? index_find(&bc->location_index, location) : NULL
+    };
+    const char* values[2] = { company, location };
     
-    while (current) {
+    bitmap_init(&owned);
+    if (!match_keyword(bc, keyword, &owned, &result)) {
+        printf("Memory allocation failed\n");
+        bitmap_free(&owned);
+        return;
+    }
+    
+    // Intersect the keyword matches with each facet filter
+    for (int f = 0; f < 2; f++) {
+        if (!values[f][0]) {
+            continue;
+        }
+        if (!facets[f]) {
+            bitmap_free(&owned);
+            result = &owned;  // Unknown value: nothing matches
+            break;
+        }
+        if (!result) {
+            result = facets[f];
+            continue;
+        }
+        
+        bitmap_init(&next);
+        if (!bitmap_and(result, facets[f], &next)) {
+            printf("Memory allocation failed\n");
+            bitmap_free(&next);
+            bitmap_free(&owned);
+            return;
+        }
+        bitmap_free(&owned);
+        owned = next;
+        result = &owned;
+    }
+    
+    if (!result) {
+        bitmap_free(&owned);
+        list_jobs(bc);  // No filters given
+        return;
+    }
+    
+    int count = bitmap_cardinality(result);
+    uint32_t* positions = (uint32_t*)malloc((count ? count : 1) * sizeof(uint32_t));
+    if (!positions) {
+        printf("Memory allocation failed\n");
+        bitmap_free(&owned);
+        return;
+    }
+    bitmap_to_array(result, positions);
+    double elapsed = now_ms() - start;
+    
+    for (int i = 0; i < count; i++) {
+        print_job(&bc->blocks[positions[i]]->job);
+    }
+    printf("%d matching job(s) (%.3f ms).\n", count, elapsed);
+    
+    free(positions);
+    bitmap_free(&owned);
+}
+
+// Find the jobs posted between `from` and `to` (inclusive) in O(log n + results)
+// with two binary searches over the time index. On success `*results` holds
+// the blocks in timestamp order and must be freed by the caller. Returns the
+// number of blocks, or -1 if memory allocation failed.
+int find_jobs_in_range(Blockchain* bc, time_t from, time_t to, Block*** results) {
+    const TimeIndex* index = &bc->time_index;
+    int first = time_bound(index, from, 0);
+    int last = time_bound(index, to, 1);
+    int count = last > first ? last - first : 0;
+    
+    *results = (Block**)malloc((count ? count : 1) * sizeof(Block*));
+    if (!*results) {
+        return -1;
+    }
+    if (count > 0) {
+        memcpy(*results, &index->sorted[first], count * sizeof(Block*));
+    }
+    return count;
+}
+
+// Print the jobs posted between `from` and `to` (inclusive) whose fields
+// contain `keyword` (any job if empty), oldest first
+void search_jobs_in_range(Blockchain* bc, const char* keyword, time_t from, time_t to) {
+    char lower_keyword[MAX_KEYWORD_LENGTH];
+    Block** results;
+    double start = now_ms();
+    
+    strcpy(lower_keyword, keyword);
+    to_lowercase(lower_keyword);
+    
+    int count = find_jobs_in_range(bc, from, to, &results);
+    if (count < 0) {
+        printf("Memory allocation failed\n");
+        return;
+    }
+    
+    int found = 0;
+    for (int i = 0; i < count; i++) {
+        if (job_matches(&results[i]->job, lower_keyword)) {
+            printf("Posted: %s", ctime(&results[i]->timestamp));
+            print_job(&results[i]->job);
+            found++;
+        }
+    }
+    printf("%d matching job(s) of %d in range (%.3f ms).\n", found, count, now_ms() - start);
+    
+    free(results);
+}
+
+// Arguments for one worker thread: it runs every `step`-th task from `first`
+typedef struct {
+    void (*run)(void* task);  // Function applied to each task
+    char* tasks;              // Array of tasks
+    size_t task_size;         // Size of one task in bytes
+    int task_count;           // Number of tasks in the array
+    int first;                // First task handled by this worker
+    int step;                 // Stride between tasks handled by this worker
+} WorkerArgs;
+
+// Thread entry point: run this worker's share of the tasks
+static void* worker_main(void* arg) {
+    WorkerArgs* w = (WorkerArgs*)arg;
+    
+    for (int i = w->first; i < w->task_count; i += w->step) {
+        w->run(w->tasks + (size_t)i * w->task_size);
+    }
+    return NULL;
+}
+
+// Run `run` over every task using up to get_worker_count() threads.
+// The calling thread acts as worker 0. Returns the number of workers used.
+static int run_parallel(void (*run)(void*), void* tasks, size_t task_size, int task_count) {
+    int workers = get_worker_count(task_count);
+    pthread_t threads[MAX_WORKER_THREADS];
+    WorkerArgs args[MAX_WORKER_THREADS];
+    int started[MAX_WORKER_THREADS] = {0};
+    
+    for (int w = 0; w < workers; w++) {
+        args[w].run = run;
+        args[w].tasks = (char*)tasks;
+        args[w].task_size = task_size;
+        args[w].task_count = task_count;
+        args[w].first = w;
+        args[w].step = workers;
+    }
+    
+    for (int w = 1; w < workers; w++) {
+        started[w] = pthread_create(&threads[w], NULL, worker_main, &args[w]) == 0;
+        if (!started[w]) {
+            worker_main(&args[w]);  // Fall back to running this share inline
+        }
+    }
+    worker_main(&args[0]);
+    
+    for (int w = 1; w < workers; w++) {
+        if (started[w]) {
+            pthread_join(threads[w], NULL);
+        }
+    }
+    return workers;
+}
+
+// Kinds of integrity failure a verification task can report
+#define VERIFY_OK 0
+#define VERIFY_POW 1
+#define VERIFY_HASH 2
+#define VERIFY_LINK 3
+
+// A run of up to one segment of consecutive blocks checked by one worker
+typedef struct {
+    Block* start;                 // First block of the run
+    const Block* prev;            // Block before `start` (NULL at the head)
+    int count;                    // Number of blocks in the run
+    int failure;                  // VERIFY_* result for the first bad block
+    const Block* failed;          // First bad block in the run, if any
+    char actual[HASH_SIZE + 1];   // Recalculated hash or actual previous hash
+} VerifyTask;
+
+// Verify proof of work, stored hash and prev_hash link for one run of blocks
+static void verify_run(void* arg) {
+    VerifyTask* task = (VerifyTask*)arg;
+    const Block* prev = task->prev;
+    Block* current = task->start;
+    
+    for (int i = 0; i < task->count; i++, prev = current, current = current->next) {
         // Verify proof of work
         if (strncmp(current->hash, "0000", DIFFICULTY) != 0) {
-            printf("Proof of work verification failed for block %d\n", current->index);
-            return 0;
+            task->failure = VERIFY_POW;
+            break;
         }
         
         // Calculate and verify the hash of the current block
-        strcpy(calculated_hash, calculate_hash(current));
-        if (strcmp(calculated_hash, current->hash) != 0) {
-            printf("Integrity breach detected at block %d\n", current->index);
-            printf("Stored hash: %s\n", current->hash);
-            printf("Calculated hash: %s\n", calculated_hash);
-            return 0;
+        compute_block_hash(current, task->actual);
+        if (strcmp(task->actual, current->hash) != 0) {
+            task->failure = VERIFY_HASH;
+            break;
         }
         
         // Verify that the prev_hash matches the hash of the previous block
-        if (current->index > 0 && strcmp(current->prev_hash, prev_hash) != 0) {
-            printf("Integrity breach detected at block %d\n", current->index);
-            printf("Stored previous hash: %s\n", current->prev_hash);
-            printf("Actual previous hash: %s\n", prev_hash);
-            return 0;
+        strcpy(task->actual, prev ? prev->hash : "");
+        if (current->index > 0 && strcmp(current->prev_hash, task->actual) != 0) {
+            task->failure = VERIFY_LINK;
+            break;
         }
+    }
+    
+    if (task->failure != VERIFY_OK) {
+        task->failed = current;
+    }
+}
+
+// Verify the integrity of the blockchain.
+// The chain is split into runs of bc->segment_size blocks which are checked
+// in parallel; the first failure in chain order is reported.
+int verify_integrity(Blockchain* bc) {
+    int block_count = 0;
+    for (Block* current = bc->head; current; current = current->next) {
+        block_count++;
+    }
+    if (block_count == 0) {
+        return 1;
+    }
+    
+    int task_count = (block_count + bc->segment_size - 1) / bc->segment_size;
+    VerifyTask* tasks = (VerifyTask*)calloc(task_count, sizeof(VerifyTask));
+    if (!tasks) {
+        printf("Memory allocation failed\n");
+        return 0;
+    }
+    
+    // Record where each run starts and the block preceding it
+    Block* current = bc->head;
+    const Block* prev = NULL;
+    for (int t = 0; t < task_count; t++) {
+        tasks[t].start = current;
+        tasks[t].prev = prev;
+        while (current && tasks[t].count < bc->segment_size) {
+            prev = current;
+            current = current->next;
+            tasks[t].count++;
+        }
+    }
+    
+    run_parallel(verify_run, tasks, sizeof(VerifyTask), task_count);
+    
+    int result = 1;
+    for (int t = 0; t < task_count && result; t++) {
+        const Block* failed = tasks[t].failed;
         
-        // Store the current hash as prev_hash for the next iteration
-        strcpy(prev_hash, current->hash);
-        current = current->next;
+        switch (tasks[t].failure) {
+            case VERIFY_POW:
+                printf("Proof of work verification failed for block %d\n", failed->index);
+                result = 0;
+                break;
+            case VERIFY_HASH:
+                printf("Integrity breach detected at block %d\n", failed->index);
+                printf("Stored hash: %s\n", failed->hash);
+                printf("Calculated hash: %s\n", tasks[t].actual);
+                result = 0;
+                break;
+            case VERIFY_LINK:
+                printf("Integrity breach detected at block %d\n", failed->index);
+                printf("Stored previous hash: %s\n", failed->prev_hash);
+                printf("Actual previous hash: %s\n", tasks[t].actual);
+                result = 0;
+                break;
+        }
     }
     
-    return 1;  // Integrity verified
+    free(tasks);
+    return result;  // 1 if integrity verified
 }
 
-// Save the blockchain to a file
-int save_blockchain(Blockchain* bc, const char* filename) {
-    FILE* file = fopen(filename, "wb");
+// Build the file name of segment `segment` of the chain saved as `filename`
+static void segment_path(char* path, size_t size, const char* filename, int segment) {
+    snprintf(path, size, "%s.%04d", filename, segment);
+}
+
+// Check whether `file` starts with MANIFEST_MAGIC, consuming it if so.
+// Otherwise the file is rewound so it can be read as a legacy single file.
+static int has_manifest_magic(FILE* file) {
+    char magic[sizeof(MANIFEST_MAGIC) - 1];
+    
+    if (fread(magic, sizeof(magic), 1, file) == 1 &&
+        memcmp(magic, MANIFEST_MAGIC, sizeof(magic)) == 0) {
+        return 1;
+    }
+    rewind(file);
+    return 0;
+}
+
+// Read the segment table of a manifest whose magic has already been consumed.
+// Returns the number of segments, or -1 if the manifest is malformed.
+static int read_manifest(FILE* file, SegmentInfo** segments, int* segment_size) {
+    int count;
+    
+    *segments = NULL;
+    if (fread(segment_size, sizeof(int), 1, file) != 1 ||
+        fread(&count, sizeof(int), 1, file) != 1 || *segment_size <= 0 || count < 0) {
+        return -1;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    
+    *segments = (SegmentInfo*)malloc(count * sizeof(SegmentInfo));
+    if (!*segments || fread(*segments, sizeof(SegmentInfo), count, file) != (size_t)count) {
+        free(*segments);
+        *segments = NULL;
+        return -1;
+    }
+    return count;
+}
+
+// Check whether two manifest entries describe the same sealed segment
+static int same_segment(const SegmentInfo* a, const SegmentInfo* b) {
+    return a->first_index == b->first_index &&
+           a->block_count == b->block_count &&
+           strcmp(a->first_prev_hash, b->first_prev_hash) == 0 &&
+           strcmp(a->last_hash, b->last_hash) == 0;
+}
+
+// Open a temporary file next to `path` (path.tmp) for writing
+static FILE* open_temp(const char* path, char* temp, size_t size) {
+    snprintf(temp, size, "%s.tmp", path);
+    
+    FILE* file = fopen(temp, "wb");
+    if (!file) {
+        printf("Error opening %s for writing\n", temp);
+    }
+    return file;
+}
+
+// Flush a file opened with open_temp to disk and rename it over `path`, so
+// `path` always holds either its old or its complete new contents. If
+// anything failed the temporary file is removed and `path` is left alone.
+static int replace_file(FILE* file, const char* temp, const char* path, int ok) {
+    ok = ok && fflush(file) == 0 && fsync(fileno(file)) == 0;
+    ok = fclose(file) == 0 && ok;
+    
+    if (ok && rename(temp, path) != 0) {
+        printf("Error replacing %s\n", path);
+        ok = 0;
+    }
+    if (!ok) {
+        remove(temp);
+    }
+    return ok;
+}
+
+// Write `count` blocks starting at `first` to segment file `segment`
+static int write_segment(const char* filename, int segment, Block* first, int count) {
+    char path[FILENAME_MAX];
+    char temp[FILENAME_MAX + 4];
+    segment_path(path, sizeof(path), filename, segment);
+    
+    FILE* file = open_temp(path, temp, sizeof(temp));
     if (!file) {
-        printf("Error opening file for writing\n");
         return 0;
     }
     
-    Block* current = bc->head;
-    while (current) {
-        fwrite(current, sizeof(Block), 1, file);
+    Block* current = first;
+    int written = 0;
+    while (current && written < count && fwrite(current, sizeof(Block), 1, file) == 1) {
         current = current->next;
+        written++;
     }
     
-    fclose(file);
-    return 1;
+    return replace_file(file, temp, path, written == count);
 }
 
-// Load the blockchain from a file
-int load_blockchain(Blockchain* bc, const char* filename) {
+// Save the blockchain to a file.
+// `filename` holds a small manifest; blocks live in segment files of
+// bc->segment_size blocks next to it (filename.0000, filename.0001, ...).
+// The segment size is recorded in the manifest. Segments that are
+// unchanged since the previous save are not rewritten, so
+// normally only the active (last) segment touches the disk. Every file is
+// written to a temporary file and renamed into place, and segment files
+// are never deleted. Saving is refused after a failed load, so a damaged
+// chain on disk is never replaced by the (possibly empty) chain in memory.
+int save_blockchain(Blockchain* bc, const char* filename) {
+    SegmentInfo* old_segments = NULL;
+    int old_count = 0;
+    int old_size = 0;
+    
+    if (bc->load_failed) {
+        printf("Not saving: %s could not be loaded, so it is left untouched.\n", filename);
+        printf("Repair it or move it (and its segment files) aside to start a new chain.\n");
+        return 0;
+    }
+    
+    // Read the previous manifest to find segments that are already on disk
     FILE* file = fopen(filename, "rb");
-    if (!file) {
-        printf("Error opening file for reading\n");
+    if (file) {
+        if (has_manifest_magic(file)) {
+            old_count = read_manifest(file, &old_segments, &old_size);
+            if (old_count < 0 || old_size != bc->segment_size) {
+                free(old_segments);
+                old_segments = NULL;
+                old_count = 0;
+            }
+        }
+        fclose(file);
+    }
+    
+    int block_count = 0;
+    for (Block* current = bc->head; current; current = current->next) {
+        block_count++;
+    }
+    
+    int segment_count = (block_count + bc->segment_size - 1) / bc->segment_size;
+    SegmentInfo* segments = (SegmentInfo*)calloc(segment_count ? segment_count : 1, sizeof(SegmentInfo));
+    if (!segments) {
+        printf("Memory allocation failed\n");
+        free(old_segments);
         return 0;
     }
     
-    init_blockchain(bc);
+    // Describe each segment and write the ones that changed
+    Block* current = bc->head;
+    int ok = 1;
+    for (int s = 0; s < segment_count && ok; s++) {
+        SegmentInfo* info = &segments[s];
+        Block* first = current;
+        Block* last = current;
+        
+        info->first_index = first->index;
+        strcpy(info->first_prev_hash, first->prev_hash);
+        while (current && info->block_count < bc->segment_size) {
+            last = current;
+            current = current->next;
+            info->block_count++;
+        }
+        strcpy(info->last_hash, last->hash);
+        
+        if (s < old_count && same_segment(info, &old_segments[s])) {
+            continue;  // Sealed segment already on disk
+        }
+        ok = write_segment(filename, s, first, info->block_count);
+    }
+    
+    // Write the manifest last so it never references a missing segment.
+    // Segment files past the new segment count are simply ignored.
+    if (ok) {
+        char temp[FILENAME_MAX + 4];
+        file = open_temp(filename, temp, sizeof(temp));
+        if (!file) {
+            ok = 0;
+        } else {
+            ok = fwrite(MANIFEST_MAGIC, sizeof(MANIFEST_MAGIC) - 1, 1, file) == 1 &&
+                 fwrite(&bc->segment_size, sizeof(int), 1, file) == 1 &&
+                 fwrite(&segment_count, sizeof(int), 1, file) == 1 &&
+                 fwrite(segments, sizeof(SegmentInfo), segment_count, file) == (size_t)segment_count;
+            ok = replace_file(file, temp, filename, ok);
+        }
+    }
     
+    free(segments);
+    free(old_segments);
+    return ok;
+}
+
+// One segment file read by a load worker
+typedef struct {
+    const char* filename;   // Manifest file name the segment belongs to
+    int segment;            // Segment number
+    SegmentInfo info;       // Manifest entry for the segment
+    Block* head;            // First block read
+    Block* tail;            // Last block read
+    int ok;                 // 1 if the segment was read and matches the manifest
+} LoadTask;
+
+// Read one segment file into a linked list of blocks
+static void load_segment(void* arg) {
+    LoadTask* task = (LoadTask*)arg;
+    char path[FILENAME_MAX];
+    segment_path(path, sizeof(path), task->filename, task->segment);
+    
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return;
+    }
+    
+    int count = 0;
     Block block;
+    while (count < task->info.block_count && fread(&block, sizeof(Block), 1, file) == 1) {
+        Block* new_block = (Block*)malloc(sizeof(Block));
+        if (!new_block) {
+            break;
+        }
+        
+        *new_block = block;
+        new_block->next = NULL;
+        
+        if (task->tail == NULL) {
+            task->head = new_block;
+        } else {
+            task->tail->next = new_block;
+        }
+        task->tail = new_block;
+        count++;
+    }
+    fclose(file);
+    
+    // The segment must match the boundary hashes recorded in the manifest
+    task->ok = count == task->info.block_count && count > 0 &&
+               task->head->index == task->info.first_index &&
+               strcmp(task->head->prev_hash, task->info.first_prev_hash) == 0 &&
+               strcmp(task->tail->hash, task->info.last_hash) == 0;
+}
+
+// Load a legacy blockchain stored as a single file of blocks
+static int load_single_file(Blockchain* bc, FILE* file) {
+    Block* head = NULL;
     Block* prev = NULL;
+    int count = 0;
+    
+    Block block;
     while (fread(&block, sizeof(Block), 1, file) == 1) {
         Block* new_block = (Block*)malloc(sizeof(Block));
         if (!new_block) {
             printf("Memory allocation failed\n");
-            fclose(file);
+            free_blocks(head);
             return 0;
         }
         
@@ -258,16 +1324,117 @@ int load_blockchain(Blockchain* bc, const char* filename) {
         new_block->next = NULL;
         
         if (prev == NULL) {
-            bc->head = new_block;
+            head = new_block;
         } else {
             prev->next = new_block;
         }
         
         prev = new_block;
-        bc->job_count++;
+        count++;
     }
     
+    free_blockchain(bc);
+    bc->head = head;
+    bc->job_count = count;
+    return 1;
+}
+
+// Load a segmented blockchain whose manifest magic has already been read
+// from `file`, with one task per segment spread over worker threads.
+static int load_segments(Blockchain* bc, FILE* file, const char* filename, LoadStats* stats) {
+    SegmentInfo* segments;
+    int segment_size;
+    int segment_count = read_manifest(file, &segments, &segment_size);
+    if (segment_count < 0) {
+        printf("Corrupt segment manifest in %s\n", filename);
+        return 0;
+    }
+    
+    LoadTask* tasks = (LoadTask*)calloc(segment_count ? segment_count : 1, sizeof(LoadTask));
+    if (!tasks) {
+        printf("Memory allocation failed\n");
+        free(segments);
+        return 0;
+    }
+    for (int s = 0; s < segment_count; s++) {
+        tasks[s].filename = filename;
+        tasks[s].segment = s;
+        tasks[s].info = segments[s];
+    }
+    free(segments);
+    
+    int threads = segment_count ? run_parallel(load_segment, tasks, sizeof(LoadTask), segment_count) : 0;
+    
+    int failed = -1;
+    for (int s = 0; s < segment_count && failed < 0; s++) {
+        if (!tasks[s].ok) {
+            failed = s;
+        }
+    }
+    if (failed >= 0) {
+        printf("Error reading segment %d of %s\n", failed, filename);
+        for (int s = 0; s < segment_count; s++) {
+            free_blocks(tasks[s].head);
+        }
+        free(tasks);
+        return 0;
+    }
+    
+    // Stitch the segments together in manifest order
+    free_blockchain(bc);
+    bc->segment_size = segment_size;
+    for (int s = 0; s < segment_count; s++) {
+        if (s == 0) {
+            bc->head = tasks[s].head;
+        } else {
+            tasks[s - 1].tail->next = tasks[s].head;
+        }
+        bc->job_count += tasks[s].info.block_count;
+    }
+    free(tasks);
+    
+    stats->segment_count = segment_count;
+    stats->thread_count = threads;
+    return 1;
+}
+
+// Load the blockchain from a file.
+// Segmented chains are read in parallel; legacy single-file chains are read
+// sequentially. The facet and term indexes are rebuilt from the loaded
+// chain. `bc` must have been initialized. If the file exists but cannot be
+// read, the chain in memory is kept; if the indexes cannot be built, the
+// chain is left empty. Either way further saves are refused.
+int load_blockchain(Blockchain* bc, const char* filename) {
+    double start = now_ms();
+    LoadStats stats = { 0, 1, 0.0 };
+    
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        printf("Error opening file for reading\n");
+        bc->load_failed = errno != ENOENT;  // A missing file just means a new chain
+        return 0;
+    }
+    
+    int ok = has_manifest_magic(file) ? load_segments(bc, file, filename, &stats)
+                                      : load_single_file(bc, file);
     fclose(file);
+    if (!ok) {
+        bc->load_failed = 1;
+        return 0;
+    }
+    
+    for (Block* current = bc->head; current; current = current->next) {
+        if (!index_block(bc, current)) {
+            // Partial indexes would make searches miss jobs, so fail the load
+            printf("Memory allocation failed while indexing job %s\n", current->job.id);
+            free_blockchain(bc);
+            bc->load_failed = 1;
+            return 0;
+        }
+    }
+    
+    stats.elapsed_ms = now_ms() - start;
+    bc->last_load = stats;
     return 1;
 }
 
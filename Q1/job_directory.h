@@ -7,11 +7,27 @@
 #include <time.h>
 #include <openssl/sha.h>
 #include <ctype.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <errno.h>
+#include "bitmap.h"
 
 #define MAX_JOBS 100
 #define HASH_SIZE 64
 #define MAX_KEYWORD_LENGTH 50
-#define DIFFICULTY 4  // Number of leading zeros required for proof of work
+#ifndef DIFFICULTY
+#define DIFFICULTY 4  // Number of leading zeros required for proof of work (at most 4)
+#endif
+#define SEGMENT_SIZE 16       // Default number of blocks stored per segment file
+#define MAX_WORKER_THREADS 8  // Upper bound on threads used to load/verify segments
+#define MANIFEST_MAGIC "JDSEGMF1"  // Marks a segment manifest (vs. a legacy single file)
+#define DEFAULT_TOP_K 10      // Number of results returned by a ranked search by default
+#define MAX_QUERY_TERMS 8     // Maximum number of keywords in a ranked search
+#define TITLE_WEIGHT 3.0      // Weight of a title hit relative to other fields
+#define BM25_K1 1.2           // BM25 term frequency saturation
+#define BM25_B 0.75           // BM25 document length normalisation
+#define RECENCY_HALF_LIFE (7 * 24 * 60 * 60)  // Age (seconds) at which the recency boost halves
 
 // Structure to represent a job listing
 typedef struct {
@@ -33,23 +49,89 @@ typedef struct Block {
     struct Block* next;     // Pointer to the next block
 } Block;
 
+// Manifest entry describing one segment file of the saved chain
+typedef struct {
+    int first_index;                      // Index of the first block in the segment
+    int block_count;                      // Number of blocks in the segment
+    char first_prev_hash[HASH_SIZE + 1];  // prev_hash of the segment's first block
+    char last_hash[HASH_SIZE + 1];        // Hash of the segment's last block
+} SegmentInfo;
+
+// Statistics about the most recent load, for reporting startup cost
+typedef struct {
+    int segment_count;      // Number of segments read (0 for a legacy single file)
+    int thread_count;       // Number of worker threads used
+    double elapsed_ms;      // Wall-clock time spent loading
+} LoadStats;
+
+// A job matched by a ranked search together with its relevance score
+typedef struct {
+    Block* block;           // Block holding the matched job
+    double score;           // BM25 score (including any recency boost)
+} ScoredJob;
+
+// Job fields that can be used as facets
+typedef enum {
+    FACET_COMPANY,
+    FACET_LOCATION
+} FacetField;
+
+// Number of matching jobs for one facet value
+typedef struct {
+    const char* value;      // Facet value (company or location)
+    int count;              // Number of matching jobs with this value
+} FacetCount;
+
+// Blocks ordered by timestamp for range queries. Blocks are appended in
+// non-decreasing time, so they are normally just added at the end; an
+// out-of-order block is inserted at its sorted position.
+typedef struct {
+    Block** sorted;         // Blocks in non-decreasing timestamp order
+    int sorted_count;       // Number of blocks in `sorted`
+    int sorted_capacity;    // Allocated length of `sorted`
+} TimeIndex;
+
 // Structure to represent the blockchain
 typedef struct {
     Block* head;            // Pointer to the first block in the chain
     int job_count;          // Counter for job IDs
+    LoadStats last_load;    // Statistics from the last load_blockchain call
+    int load_failed;        // Set if the chain on disk could not be loaded (saving is refused)
+    int segment_size;       // Blocks per segment file (taken from the manifest on load)
+    Block** blocks;         // Blocks by position, so index hits can be resolved
+    int block_count;        // Number of blocks in `blocks`
+    int block_capacity;     // Allocated length of `blocks`
+    TimeIndex time_index;   // Blocks by timestamp
+    BitmapIndex company_index;   // Company -> positions of its jobs
+    BitmapIndex location_index;  // Location -> positions of its jobs
+    BitmapIndex term_index;      // Lowercase word -> positions of jobs containing it
+    double total_length;         // Field-weighted word count of all indexed jobs (for BM25)
 } Blockchain;
 
 // Function prototypes
 void init_blockchain(Blockchain* bc);
+void free_blockchain(Blockchain* bc);
 void add_job(Blockchain* bc, Job job);
 void list_jobs(Blockchain* bc);
 void search_jobs(Blockchain* bc, const char* keyword);
+int rank_jobs(Blockchain* bc, const char* query, int k, int recency_boost,
+              ScoredJob* results, int* match_count);
+void search_jobs_ranked(Blockchain* bc, const char* query, int k, int recency_boost);
+int index_block(Blockchain* bc, Block* block);
+int facet_counts(Blockchain* bc, FacetField field, const char* keyword, FacetCount** counts);
+void print_facet_counts(Blockchain* bc, FacetField field, const char* keyword);
+int find_jobs_in_range(Blockchain* bc, time_t from, time_t to, Block*** results);
+void search_jobs_in_range(Blockchain* bc, const char* keyword, time_t from, time_t to);
+void filter_jobs(Blockchain* bc, const char* keyword, const char* company, const char* location);
 int verify_integrity(Blockchain* bc);
 void print_blockchain(Blockchain* bc);
 char* calculate_hash(Block* block);
+void compute_block_hash(const Block* block, char* hash);
 void to_lowercase(char *str);
 int save_blockchain(Blockchain* bc, const char* filename);
 int load_blockchain(Blockchain* bc, const char* filename);
 void mine_block(Block* block);
+int get_worker_count(int tasks);
+double now_ms(void);
 
 #endif // JOB_DIRECTORY_H
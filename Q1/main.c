@@ -15,6 +15,10 @@ void print_menu() {
     printf("5. Save Blockchain\n");
     printf("6. Load Blockchain\n");
     printf("7. Exit\n");
+    printf("8. Ranked Search\n");
+    printf("9. Filter Jobs\n");
+    printf("10. Facet Counts\n");
+    printf("11. Jobs by Date Range\n");
     printf("Enter your choice: ");
 }
 
@@ -47,16 +51,74 @@ Job input_job() {
     return job;
 }
 
+// Function to read a point in time from the user.
+// Accepts "YYYY-MM-DD", "YYYY-MM-DD HH:MM" (local time), "-Nh" or "-Nd"
+// (N hours/days ago), or a blank line for `fallback`. A date without a time
+// means the start of the day, or its end if `end_of_day` is set.
+// Returns 0 if the input could not be parsed.
+int input_time(const char* prompt, time_t fallback, int end_of_day, time_t* result) {
+    char line[64];
+    struct tm tm = {0};
+    int amount;
+    char unit;
+    
+    printf("%s", prompt);
+    if (!fgets(line, sizeof(line), stdin)) {
+        return 0;
+    }
+    line[strcspn(line, "\n")] = 0;  // Remove newline character
+    
+    if (line[0] == '\0') {
+        *result = fallback;
+        return 1;
+    }
+    if (sscanf(line, "-%d%c", &amount, &unit) == 2 && amount >= 0 && (unit == 'h' || unit == 'd')) {
+        *result = time(NULL) - (time_t)amount * (unit == 'h' ? 3600 : 86400);
+        return 1;
+    }
+    
+    int fields = sscanf(line, "%d-%d-%d %d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+                        &tm.tm_hour, &tm.tm_min);
+    if (fields != 3 && fields != 5) {
+        return 0;
+    }
+    if (fields == 3 && end_of_day) {
+        tm.tm_hour = 23;
+        tm.tm_min = 59;
+        tm.tm_sec = 59;
+    }
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    tm.tm_isdst = -1;
+    *result = mktime(&tm);
+    return *result != (time_t)-1;
+}
+
+// Function to report how long the last load took
+void print_load_stats(Blockchain* bc) {
+    LoadStats* stats = &bc->last_load;
+    printf("Loaded %d block(s) from %d segment(s) using %d thread(s) in %.3f ms.\n",
+           bc->job_count, stats->segment_count, stats->thread_count, stats->elapsed_ms);
+}
+
 int main() {
     Blockchain bc;
     init_blockchain(&bc);
     int choice;
     char keyword[MAX_KEYWORD_LENGTH];
+    char answer[16];
+    int top_k;
     Job job;
+    char company[sizeof(job.company)];
+    char location[sizeof(job.location)];
+    time_t from, to;
 
     // Load existing blockchain if file exists
     if (load_blockchain(&bc, BLOCKCHAIN_FILE)) {
         printf("Existing blockchain loaded.\n");
+        print_load_stats(&bc);
+    } else if (bc.load_failed) {
+        printf("Existing blockchain could not be loaded and will not be overwritten.\n");
     } else {
         printf("No existing blockchain found. Starting with an empty chain.\n");
     }
@@ -85,13 +147,16 @@ int main() {
                 keyword[strcspn(keyword, "\n")] = 0; // Remove newline
                 search_jobs(&bc, keyword);
                 break;
-            case 4: // Verify Integrity
+            case 4: { // Verify Integrity
+                double start = now_ms();
                 if (verify_integrity(&bc)) {
                     printf("Blockchain integrity verified.\n");
                 } else {
                     printf("Blockchain integrity compromised.\n");
                 }
+                printf("Verification took %.3f ms.\n", now_ms() - start);
                 break;
+            }
             case 5: // Save Blockchain
                 if (save_blockchain(&bc, BLOCKCHAIN_FILE)) {
                     printf("Blockchain saved successfully.\n");
@@ -102,6 +167,7 @@ int main() {
             case 6: // Load Blockchain
                 if (load_blockchain(&bc, BLOCKCHAIN_FILE)) {
                     printf("Blockchain loaded successfully.\n");
+                    print_load_stats(&bc);
                 } else {
                     printf("Failed to load blockchain.\n");
                 }
@@ -114,7 +180,50 @@ int main() {
                     printf("Failed to save blockchain.\n");
                 }
                 printf("Exiting program.\n");
+                free_blockchain(&bc);
                 return 0;
+            case 8: // Ranked Search
+                printf("Enter search keywords: ");
+                fgets(keyword, MAX_KEYWORD_LENGTH, stdin);
+                keyword[strcspn(keyword, "\n")] = 0; // Remove newline
+                printf("Number of results [%d]: ", DEFAULT_TOP_K);
+                fgets(answer, sizeof(answer), stdin);
+                top_k = atoi(answer) > 0 ? atoi(answer) : DEFAULT_TOP_K;
+                printf("Boost recent jobs? (y/n): ");
+                fgets(answer, sizeof(answer), stdin);
+                search_jobs_ranked(&bc, keyword, top_k, tolower(answer[0]) == 'y');
+                break;
+            case 9: // Filter Jobs
+                printf("Enter search keyword (blank for any): ");
+                fgets(keyword, MAX_KEYWORD_LENGTH, stdin);
+                keyword[strcspn(keyword, "\n")] = 0; // Remove newline
+                printf("Enter company (blank for any): ");
+                fgets(company, sizeof(company), stdin);
+                company[strcspn(company, "\n")] = 0;
+                printf("Enter location (blank for any): ");
+                fgets(location, sizeof(location), stdin);
+                location[strcspn(location, "\n")] = 0;
+                filter_jobs(&bc, keyword, company, location);
+                break;
+            case 10: // Facet Counts
+                printf("Count by (c)ompany or (l)ocation: ");
+                fgets(answer, sizeof(answer), stdin);
+                printf("Enter search keyword (blank for all jobs): ");
+                fgets(keyword, MAX_KEYWORD_LENGTH, stdin);
+                keyword[strcspn(keyword, "\n")] = 0; // Remove newline
+                print_facet_counts(&bc, tolower(answer[0]) == 'c' ? FACET_COMPANY : FACET_LOCATION, keyword);
+                break;
+            case 11: // Jobs by Date Range
+                if (!input_time("Enter start (YYYY-MM-DD [HH:MM], -Nh, -Nd, blank for any): ", 0, 0, &from) ||
+                    !input_time("Enter end (YYYY-MM-DD [HH:MM], blank for now): ", time(NULL), 1, &to)) {
+                    printf("Invalid date.\n");
+                    break;
+                }
+                printf("Enter search keyword (blank for any): ");
+                fgets(keyword, MAX_KEYWORD_LENGTH, stdin);
+                keyword[strcspn(keyword, "\n")] = 0; // Remove newline
+                search_jobs_in_range(&bc, keyword, from, to);
+                break;
             default:
                 printf("Invalid choice. Please try again.\n");
         }
@@ -27,11 +27,21 @@ typedef struct Block {
     struct Block* next;
 } Block;
 
+// Blocks ordered by timestamp for range queries. Blocks are mined in
+// non-decreasing time, so they are normally just appended; a block older
+// than the newest one (e.g. after a clock change) is inserted in place.
+typedef struct {
+    Block** sorted;        // Blocks in non-decreasing timestamp order
+    int sorted_count;
+    int sorted_capacity;
+} TimeIndex;
+
 // Blockchain structure
 typedef struct {
     Block* head;
     Block* pending_block; // Block to store pending transactions
     bool is_initialized;
+    TimeIndex time_index; // Mined blocks by timestamp
 } Blockchain;
 
 // Function prototypes
@@ -40,7 +50,12 @@ void mine_block(Block* block);
 bool add_transaction(Block* block, int item_id, const char* description);
 void create_blockchain(Blockchain* blockchain);
 void add_block(Blockchain* blockchain, Block* new_block);
+void print_block(Block* block);
 void print_blockchain(Blockchain* blockchain);
+bool time_index_add(TimeIndex* index, Block* block);
+int find_blocks_in_range(Blockchain* blockchain, time_t from, time_t to, Block*** results);
+void print_blocks_in_range(Blockchain* blockchain, time_t from, time_t to);
+bool input_time(const char* prompt, time_t fallback, bool end_of_day, time_t* result);
 void clear_input_buffer();
 int display_menu(bool blockchain_initialized, bool has_pending_transactions);
 
@@ -97,6 +112,7 @@ bool add_transaction(Block* block, int item_id, const char* description) {
 void create_blockchain(Blockchain* blockchain) {
     blockchain->head = NULL;
     blockchain->is_initialized = true;
+    memset(&blockchain->time_index, 0, sizeof(TimeIndex));
 
     // Create a new pending block
     blockchain->pending_block = (Block*)malloc(sizeof(Block));
@@ -121,6 +137,94 @@ void add_block(Blockchain* blockchain, Block* new_block) {
 
     mine_block(new_block);
     blockchain->head = new_block;
+
+    if (!time_index_add(&blockchain->time_index, new_block)) {
+        fprintf(stderr, "Error: Unable to allocate memory for time index.\n");
+        exit(1);
+    }
+}
+
+// Append a block pointer to a growable array
+static bool append_block(Block*** array, int* count, int* capacity, Block* block) {
+    if (*count == *capacity) {
+        int new_capacity = *capacity ? *capacity * 2 : 16;
+        Block** grown = (Block**)realloc(*array, new_capacity * sizeof(Block*));
+        if (grown == NULL) {
+            return false;
+        }
+        *array = grown;
+        *capacity = new_capacity;
+    }
+    (*array)[(*count)++] = block;
+    return true;
+}
+
+// Position of the first sorted block with a timestamp >= t (or > t if after)
+static int time_bound(const TimeIndex* index, time_t t, bool after) {
+    int low = 0;
+    int high = index->sorted_count;
+
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        time_t ts = index->sorted[mid]->timestamp;
+        if (ts < t || (after && ts == t)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Add a mined block to the time index. An out-of-order block is inserted at
+// its sorted position; this is rare, so the memmove does not matter.
+bool time_index_add(TimeIndex* index, Block* block) {
+    int pos = time_bound(index, block->timestamp, true);
+
+    if (!append_block(&index->sorted, &index->sorted_count, &index->sorted_capacity, block)) {
+        return false;
+    }
+    if (pos < index->sorted_count - 1) {
+        memmove(&index->sorted[pos + 1], &index->sorted[pos],
+                (index->sorted_count - 1 - pos) * sizeof(Block*));
+        index->sorted[pos] = block;
+    }
+    return true;
+}
+
+// Find the blocks mined between from and to (inclusive) in O(log n + results)
+// with two binary searches over the time index. On success *results holds
+// the blocks oldest first and must be freed by the caller. Returns the
+// number of blocks, or -1 if memory allocation failed.
+int find_blocks_in_range(Blockchain* blockchain, time_t from, time_t to, Block*** results) {
+    const TimeIndex* index = &blockchain->time_index;
+    int first = time_bound(index, from, false);
+    int last = time_bound(index, to, true);
+    int count = last > first ? last - first : 0;
+
+    *results = (Block**)malloc((count ? count : 1) * sizeof(Block*));
+    if (*results == NULL) {
+        return -1;
+    }
+    if (count > 0) {
+        memcpy(*results, &index->sorted[first], count * sizeof(Block*));
+    }
+    return count;
+}
+
+// Print a single block and its transactions
+void print_block(Block* block) {
+    printf("Block %d\n", block->index);
+    printf("Timestamp: %ld\n", block->timestamp);
+    printf("Transactions:\n");
+    for (int i = 0; i < block->transaction_count; i++) {
+        printf("  Item ID: %d, Description: %s\n", 
+               block->transactions[i].item_id, 
+               block->transactions[i].description);
+    }
+    printf("Previous Hash: %s\n", block->previous_hash);
+    printf("Hash: %s\n", block->hash);
+    printf("Nonce: %d\n\n", block->nonce);
 }
 
 // Print the entire blockchain
@@ -137,27 +241,77 @@ void print_blockchain(Blockchain* blockchain) {
 
     Block* current = blockchain->head;
     while (current != NULL) {
-        printf("Block %d\n", current->index);
-        printf("Timestamp: %ld\n", current->timestamp);
-        printf("Transactions:\n");
-        for (int i = 0; i < current->transaction_count; i++) {
-            printf("  Item ID: %d, Description: %s\n", 
-                   current->transactions[i].item_id, 
-                   current->transactions[i].description);
-        }
-        printf("Previous Hash: %s\n", current->previous_hash);
-        printf("Hash: %s\n", current->hash);
-        printf("Nonce: %d\n\n", current->nonce);
+        print_block(current);
         current = current->next;
     }
 }
 
+// Print the blocks mined between from and to (inclusive), oldest first
+void print_blocks_in_range(Blockchain* blockchain, time_t from, time_t to) {
+    Block** results;
+    int count = find_blocks_in_range(blockchain, from, to, &results);
+    if (count < 0) {
+        fprintf(stderr, "Error: Unable to allocate memory for query results.\n");
+        return;
+    }
+
+    if (count == 0) {
+        printf("No blocks were mined in that time range.\n");
+    }
+    for (int i = 0; i < count; i++) {
+        print_block(results[i]);
+    }
+    free(results);
+}
+
 // Function to clear the input buffer
 void clear_input_buffer() {
     int c;
     while ((c = getchar()) != '\n' && c != EOF) { }
 }
 
+// Read a point in time from the user.
+// Accepts "YYYY-MM-DD", "YYYY-MM-DD HH:MM" (local time), "-Nh" or "-Nd"
+// (N hours/days ago), or a blank line for fallback. A date without a time
+// means the start of the day, or its end if end_of_day is set.
+bool input_time(const char* prompt, time_t fallback, bool end_of_day, time_t* result) {
+    char line[64];
+    struct tm tm = {0};
+    int amount;
+    char unit;
+
+    printf("%s", prompt);
+    if (fgets(line, sizeof(line), stdin) == NULL) {
+        return false;
+    }
+    line[strcspn(line, "\n")] = 0; // Remove trailing newline
+
+    if (line[0] == '\0') {
+        *result = fallback;
+        return true;
+    }
+    if (sscanf(line, "-%d%c", &amount, &unit) == 2 && amount >= 0 && (unit == 'h' || unit == 'd')) {
+        *result = time(NULL) - (time_t)amount * (unit == 'h' ? 3600 : 86400);
+        return true;
+    }
+
+    int fields = sscanf(line, "%d-%d-%d %d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+                        &tm.tm_hour, &tm.tm_min);
+    if (fields != 3 && fields != 5) {
+        return false;
+    }
+    if (fields == 3 && end_of_day) {
+        tm.tm_hour = 23;
+        tm.tm_min = 59;
+        tm.tm_sec = 59;
+    }
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    tm.tm_isdst = -1;
+    *result = mktime(&tm);
+    return *result != (time_t)-1;
+}
+
 // Function to display the menu and get user choice
 int display_menu(bool blockchain_initialized, bool has_pending_transactions) {
     int choice;
@@ -171,6 +325,9 @@ int display_menu(bool blockchain_initialized, bool has_pending_transactions) {
         printf("4. Print blockchain\n");
     }
     printf("5. Exit\n");
+    if (blockchain_initialized) {
+        printf("6. Query blocks by time range\n");
+    }
     printf("Enter your choice: ");
     scanf("%d", &choice);
     clear_input_buffer();
@@ -179,7 +336,7 @@ int display_menu(bool blockchain_initialized, bool has_pending_transactions) {
 
 // Main function with menu-driven CLI
 int main() {
-    Blockchain blockchain = {NULL, NULL, false};
+    Blockchain blockchain = {NULL, NULL, false, {0}};
     int choice;
     
     while (1) {
@@ -250,6 +407,20 @@ int main() {
                 printf("Exiting program. Goodbye!\n");
                 exit(0);
             
+            case 6:
+                if (!blockchain.is_initialized) {
+                    printf("Please initialize the blockchain first.\n");
+                    break;
+                }
+                time_t from, to;
+                if (!input_time("Enter start (YYYY-MM-DD [HH:MM], -Nh, -Nd, blank for any): ", 0, false, &from) ||
+                    !input_time("Enter end (YYYY-MM-DD [HH:MM], blank for now): ", time(NULL), true, &to)) {
+                    printf("Invalid date.\n");
+                    break;
+                }
+                print_blocks_in_range(&blockchain, from, to);
+                break;
+            
             default:
                 printf("Invalid choice. Please try again.\n");
         }